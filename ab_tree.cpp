@@ -154,6 +154,111 @@ class ab_tree {
         this->divide_too_big_child(0, nullptr, this->root);
     }
 
+    // Bulk load: build the tree bottom-up from a strictly increasing range of keys.
+    // Every node gets about fill_factor * b children (but always between a and b),
+    // so 1.0 packs the nodes fully and e.g. 0.7 leaves room for later inserts.
+    // The tree must be empty. The keys are read in one pass, so any input
+    // iterator works, and only the nodes above the bottom level are collected.
+    template <class Iterator>
+    void bulk_load(Iterator first, Iterator last, double fill_factor = 1.0) {
+        EXPECT(root->keys.empty(), "Bulk loading requires an empty tree");
+        EXPECT(fill_factor > 0 && fill_factor <= 1, "Invalid fill factor");
+        int target = (int)(fill_factor * this->b + 0.5);
+        if (target < this->a) target = this->a;
+        if (target > this->b) target = this->b;
+        if (first == last)
+            return;
+
+        // The current level is a sequence of subtrees separated by keys:
+        // level[0] keys[0] level[1] keys[1] ... level[n].
+        vector<ab_node *> level;
+        vector<int> keys;
+
+        // The bottom level is filled greedily while streaming the input:
+        // target - 1 keys go to a node, the next key separates it from the following one.
+        ab_node *n = this->new_node();
+        n->children.push_back(nullptr);
+        bool hasPrevious = false;
+        int previous = 0;
+        for (; first != last; ++first) {
+            int key = *first;
+            EXPECT(!hasPrevious || previous < key, "Bulk loaded keys must be sorted and distinct");
+            hasPrevious = true;
+            previous = key;
+            if (n->keys.size() < target - 1) {
+                n->insert_branch(n->keys.size(), key, nullptr);
+            } else {
+                level.push_back(n);
+                keys.push_back(key);
+                n = this->new_node();
+                n->children.push_back(nullptr);
+            }
+        }
+        level.push_back(n);
+
+        // the last node may be too small, so merge it with its left neighbour
+        // or redistribute the keys of both evenly
+        if (level.size() > 1 && n->keys.size() < this->a - 1) {
+            ab_node *left = level[level.size() - 2];
+            vector<int> both(left->keys);
+            both.push_back(keys.back());
+            both.insert(both.end(), n->keys.begin(), n->keys.end());
+            if (both.size() <= this->b - 1) {
+                left->keys = both;
+                left->children.resize(both.size() + 1, nullptr);
+                this->delete_node(n);
+                level.pop_back();
+                keys.pop_back();
+            } else {
+                int middleIndex = (both.size() - 1) / 2;
+                left->keys.assign(both.begin(), both.begin() + middleIndex);
+                left->children.resize(middleIndex + 1);
+                keys.back() = both[middleIndex];
+                n->keys.assign(both.begin() + middleIndex + 1, both.end());
+                n->children.resize(n->keys.size() + 1, nullptr);
+            }
+        }
+
+        // group the nodes into upper levels until one node is enough
+        while (level.size() > this->b) {
+            // pick the number of nodes closest to the target fill, but keep
+            // every node between a and b children (possible since b >= 2a - 1)
+            int total = level.size();
+            int count = (total + target - 1) / target;
+            if (count > total / this->a) count = total / this->a;
+            if (count < (total + this->b - 1) / this->b) count = (total + this->b - 1) / this->b;
+
+            // spread the children evenly, every separator between two nodes goes up
+            vector<ab_node *> upperLevel;
+            vector<int> upperKeys;
+            upperLevel.reserve(count);
+            upperKeys.reserve(count - 1);
+            int next = 0;
+            for (int i = 0; i < count; i++) {
+                int size = total / count + (i < total % count ? 1 : 0);
+                ab_node *n = this->new_node();
+                for (int j = 0; j < size; j++) {
+                    if (j > 0) n->keys.push_back(keys[next + j - 1]);
+                    n->children.push_back(level[next + j]);
+                }
+                next += size;
+                upperLevel.push_back(n);
+                if (i + 1 < count) upperKeys.push_back(keys[next - 1]);
+            }
+            level.swap(upperLevel);
+            keys.swap(upperKeys);
+        }
+
+        // the rest fits into the root
+        if (level.size() == 1) {
+            this->delete_node(root);
+            root = level[0];
+        } else {
+            root->keys = keys;
+            root->children = level;
+        }
+    }
+
     // remove: remove key from the tree (unless it doesnt exist in the tree).
     void remove(int key) {
         // TODO
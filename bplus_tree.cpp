@@ -0,0 +1,279 @@
+#include <cstddef>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <vector>
+
+using namespace std;
+
+// If the condition is not true, report an error and halt.
+#define EXPECT(condition, message)                \
+    do {                                          \
+        if (!(condition)) expect_failed(message); \
+    } while (0)
+
+void expect_failed(const string &message);
+
+// Hint the CPU to start loading the given address into the cache.
+#if defined(__GNUC__)
+#define PREFETCH(address) __builtin_prefetch(address)
+#else
+#define PREFETCH(address) ((void)(address))
+#endif
+
+/*** Tree ***/
+
+// (a,b)-tree in the B+-tree layout: internal nodes hold only separators
+// and all keys live in leaves which are linked from left to right, so
+// an ordered scan walks the leaf chain instead of the whole tree.
+class bplus_tree {
+   private:
+    /*** One node ***/
+
+    class bp_node {
+       public:
+        // Keys stored in this node. In an internal node, keys[i] is the smallest
+        // key of the subtree children[i+1]. Leaves have no children.
+        // The vectors are large enough to accomodate one extra entry
+        // in overflowing nodes.
+        vector<bp_node *> children;
+        vector<int> keys;
+        bp_node *next;  // Next leaf to the right (only used in leaves)
+        bool leaf;
+
+        // Return the index of the child whose subtree may contain the given key.
+        int find_child(int key) {
+            int i = 0;
+            while (i < keys.size() && keys[i] <= key)
+                i++;
+            return i;
+        }
+
+        // Return the position of the first key which is not smaller than the given one.
+        int find_position(int key) {
+            int i = 0;
+            while (i < keys.size() && keys[i] < key)
+                i++;
+            return i;
+        }
+    };
+
+   public:
+    /*** Forward iterator over keys in increasing order ***/
+
+    class iterator {
+        bp_node *leaf;  // Current leaf; nullptr for the end of the tree
+        int index;      // Position of the current key in the leaf
+
+        // Move to the next leaf while the current one is exhausted.
+        void skip_exhausted() {
+            while (leaf && index == leaf->keys.size()) {
+                leaf = leaf->next;
+                index = 0;
+                if (leaf && leaf->next)
+                    PREFETCH(leaf->next);
+            }
+        }
+
+       public:
+        typedef forward_iterator_tag iterator_category;
+        typedef int value_type;
+        typedef ptrdiff_t difference_type;
+        typedef const int *pointer;
+        typedef const int &reference;
+
+        iterator(bp_node *leaf = nullptr, int index = 0) {
+            this->leaf = leaf;
+            this->index = index;
+            skip_exhausted();
+            // operator++ reads leaf->next halfway through the leaf
+            if (this->leaf && this->leaf->next)
+                PREFETCH(this->leaf->next);
+        }
+
+        const int &operator*() const {
+            return leaf->keys[index];
+        }
+
+        iterator &operator++() {
+            index++;
+            // Halfway through the leaf, the next node is already cached,
+            // so we can ask for its keys too.
+            if (index == leaf->keys.size() / 2 && leaf->next)
+                PREFETCH(leaf->next->keys.data());
+            skip_exhausted();
+            return *this;
+        }
+
+        iterator operator++(int) {
+            iterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        bool operator==(const iterator &other) const {
+            return leaf == other.leaf && index == other.index;
+        }
+
+        bool operator!=(const iterator &other) const {
+            return !(*this == other);
+        }
+    };
+
+    // A half-open range of keys [lo, hi) usable in range-based for loops.
+    class range {
+        iterator first, last;
+
+       public:
+        range(iterator first, iterator last) : first(first), last(last) {}
+        iterator begin() const { return first; }
+        iterator end() const { return last; }
+    };
+
+   private:
+    int a;          // Minimum allowed number of children
+    int b;          // Maximum allowed number of children
+    bp_node *root;  // Root node (even a tree with no keys has a root)
+    int num_nodes;  // We keep track of how many nodes the tree has
+
+    // Create a new node and return a pointer to it.
+    bp_node *new_node(bool leaf) {
+        bp_node *n = new bp_node;
+        n->keys.reserve(b);
+        if (!leaf)
+            n->children.reserve(b + 1);
+        n->next = nullptr;
+        n->leaf = leaf;
+        num_nodes++;
+        return n;
+    }
+
+    // Delete a given node, assuming that its children have been already unlinked.
+    void delete_node(bp_node *n) {
+        num_nodes--;
+        delete n;
+    }
+
+    // An auxiliary function for deleting a subtree recursively.
+    void delete_tree(bp_node *n) {
+        for (int i = 0; i < n->children.size(); i++)
+            delete_tree(n->children[i]);
+        delete_node(n);
+    }
+
+    // Descend to the leaf which may contain the given key.
+    bp_node *find_leaf(int key) {
+        bp_node *n = root;
+        while (!n->leaf)
+            n = n->children[n->find_child(key)];
+        return n;
+    }
+
+    void recursive_insert(int key, bp_node *node) {
+        if (node->leaf) {
+            int index = node->find_position(key);
+            if (index == node->keys.size() || node->keys[index] != key)
+                node->keys.insert(node->keys.begin() + index, key);
+            return;
+        }
+
+        int index = node->find_child(key);
+        bp_node *child = node->children[index];
+        this->recursive_insert(key, child);
+
+        // fixing potencial too big child of node
+        this->divide_too_big_child(index, node, child);
+    }
+
+    // Split an overflowing child in place: its upper half moves to a new right sibling.
+    void divide_too_big_child(int parentIndex, bp_node *parent, bp_node *child) {
+        if (child->keys.size() < this->b)
+            return;
+
+        int middleIndex = (this->b - 1) / 2;
+        bp_node *newRightChild = this->new_node(child->leaf);
+        int separator = child->keys[middleIndex];
+
+        if (child->leaf) {
+            // the separator is copied up and stays in the right leaf
+            newRightChild->keys.assign(child->keys.begin() + middleIndex, child->keys.end());
+            child->keys.resize(middleIndex);
+            newRightChild->next = child->next;
+            child->next = newRightChild;
+        } else {
+            // the separator moves up to the parent
+            newRightChild->keys.assign(child->keys.begin() + middleIndex + 1, child->keys.end());
+            newRightChild->children.assign(child->children.begin() + middleIndex + 1, child->children.end());
+            child->keys.resize(middleIndex);
+            child->children.resize(middleIndex + 1);
+        }
+
+        // join the new right child to the current parent
+        if (parent) {  // it is called for inner node
+            parent->keys.insert(parent->keys.begin() + parentIndex, separator);
+            parent->children.insert(parent->children.begin() + parentIndex + 1, newRightChild);
+        } else {  // it is called for the root and the root does not have a parent
+            bp_node *newRoot = this->new_node(false);
+            newRoot->keys.push_back(separator);
+            newRoot->children.push_back(child);
+            newRoot->children.push_back(newRightChild);
+            this->root = newRoot;
+        }
+    }
+
+   public:
+    // Constructor: initialize an empty tree with just the root.
+    bplus_tree(int a, int b) {
+        EXPECT(a >= 2 && b >= 2 * a - 1, "Invalid values of a,b");
+        this->a = a;
+        this->b = b;
+        num_nodes = 0;
+        // The root is an empty leaf.
+        root = new_node(true);
+    }
+
+    // Find a key: returns true if it is present in the tree.
+    bool find(int key) {
+        bp_node *n = find_leaf(key);
+        int i = n->find_position(key);
+        return i < n->keys.size() && n->keys[i] == key;
+    }
+
+    // Insert: add key to the tree (unless it was already present).
+    void insert(int key) {
+        this->recursive_insert(key, this->root);
+        // fixing potencial too big the root
+        this->divide_too_big_child(0, nullptr, this->root);
+    }
+
+    // Return an iterator to the first key which is not smaller than the given one.
+    iterator lower_bound(int key) {
+        bp_node *n = find_leaf(key);
+        return iterator(n, n->find_position(key));
+    }
+
+    // Iterators over all keys in increasing order.
+    iterator begin() {
+        bp_node *n = root;
+        while (!n->leaf)
+            n = n->children[0];
+        return iterator(n, 0);
+    }
+
+    iterator end() {
+        return iterator();
+    }
+
+    // Return all keys k with lo <= k < hi in increasing order.
+    range scan(int lo, int hi) {
+        if (hi <= lo)
+            return range(end(), end());
+        return range(lower_bound(lo), lower_bound(hi));
+    }
+
+    // Destructor: delete all nodes.
+    ~bplus_tree() {
+        this->delete_tree(root);
+        EXPECT(num_nodes == 0, "Memory leak detected: some nodes were not deleted");
+    }
+};
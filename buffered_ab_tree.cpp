@@ -0,0 +1,266 @@
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+using namespace std;
+
+// If the condition is not true, report an error and halt.
+#define EXPECT(condition, message)                \
+    do {                                          \
+        if (!(condition)) expect_failed(message); \
+    } while (0)
+
+void expect_failed(const string &message);
+
+/*** Tree ***/
+
+// Write-optimized (a,b)-tree in the style of a B^epsilon-tree. Keys live in
+// leaves and every internal node keeps a buffer of pending inserts and removes.
+// Updates land in the root buffer. When a buffer overflows, the messages for
+// the child which receives most of them are moved one level down in a batch.
+// A buffer is kept partitioned by child, so the target of a message is found
+// only once per level, when the message enters the buffer.
+// So a single descent is shared by many updates, at the price of lookups
+// that also check the buffers along their path.
+class buffered_ab_tree {
+   private:
+    /*** One pending update ***/
+
+    class message {
+       public:
+        int key;
+        bool remove;  // true for remove, false for insert
+    };
+
+    /*** One node ***/
+
+    class bf_node {
+       public:
+        // Keys stored in this node. In an internal node, keys[i] is the smallest
+        // key of the subtree children[i+1]. Leaves have no children and no buffer.
+        vector<bf_node *> children;
+        vector<int> keys;
+        // Pending updates for the subtree: buffers[i] holds the messages for
+        // children[i] in the order of arrival, buffered is their total number.
+        vector<vector<message>> buffers;
+        int buffered;
+        bool leaf;
+
+        // Return the index of the child whose subtree may contain the given key.
+        int find_child(int key) {
+            return upper_bound(keys.begin(), keys.end(), key) - keys.begin();
+        }
+
+        // Return the position of the first key which is not smaller than the given one.
+        int find_position(int key) {
+            return lower_bound(keys.begin(), keys.end(), key) - keys.begin();
+        }
+
+        // Add a message to the buffer of the child whose subtree contains its key.
+        void buffer_message(const message &m) {
+            buffers[find_child(m.key)].push_back(m);
+            buffered++;
+        }
+    };
+
+    int a;            // Minimum allowed number of children
+    int b;            // Maximum allowed number of children
+    int buffer_size;  // Maximum number of messages buffered in one node
+    bf_node *root;    // Root node (even a tree with no keys has a root)
+    int num_nodes;    // We keep track of how many nodes the tree has
+
+    // Create a new node and return a pointer to it.
+    bf_node *new_node(bool leaf) {
+        bf_node *n = new bf_node;
+        n->keys.reserve(b);
+        if (!leaf) {
+            n->children.reserve(b + 1);
+            n->buffers.reserve(b + 1);
+        }
+        n->buffered = 0;
+        n->leaf = leaf;
+        num_nodes++;
+        return n;
+    }
+
+    // Delete a given node, assuming that its children have been already unlinked.
+    void delete_node(bf_node *n) {
+        num_nodes--;
+        delete n;
+    }
+
+    // An auxiliary function for deleting a subtree recursively.
+    void delete_tree(bf_node *n) {
+        for (int i = 0; i < n->children.size(); i++)
+            delete_tree(n->children[i]);
+        delete_node(n);
+    }
+
+    // Apply one message to a leaf. The leaf may overflow.
+    void apply_to_leaf(bf_node *leaf, const message &m) {
+        int i = leaf->find_position(m.key);
+        bool present = i < leaf->keys.size() && leaf->keys[i] == m.key;
+        if (m.remove && present)
+            leaf->keys.erase(leaf->keys.begin() + i);
+        else if (!m.remove && !present)
+            leaf->keys.insert(leaf->keys.begin() + i, m.key);
+    }
+
+    // Move messages down from an overflowing buffer, always to the child
+    // which receives most of them, until the buffer fits again.
+    void flush(bf_node *node) {
+        while (node->buffered > this->buffer_size) {
+            int best = 0;
+            for (int i = 1; i < node->buffers.size(); i++)
+                if (node->buffers[i].size() > node->buffers[best].size())
+                    best = i;
+
+            // messages keep their order, so the newest update of a key still wins
+            bf_node *child = node->children[best];
+            vector<message> &batch = node->buffers[best];
+            for (int i = 0; i < batch.size(); i++) {
+                if (child->leaf)
+                    this->apply_to_leaf(child, batch[i]);
+                else
+                    child->buffer_message(batch[i]);
+            }
+            node->buffered -= batch.size();
+            batch.clear();
+
+            if (!child->leaf && child->buffered > this->buffer_size)
+                this->flush(child);
+
+            // fixing potencial too big child of node
+            this->divide_too_big_children(node, best);
+        }
+    }
+
+    // Split the child at the given index, its upper part moves to a new right sibling.
+    // After a batch of messages the child may be several times too big,
+    // so the left part takes at most b-1 keys and the rest is split further later.
+    void divide_child(bf_node *parent, int parentIndex) {
+        bf_node *child = parent->children[parentIndex];
+        int middleIndex = child->keys.size() / 2;
+        if (middleIndex > this->b - 1) middleIndex = this->b - 1;
+        bf_node *newRightChild = this->new_node(child->leaf);
+        int separator = child->keys[middleIndex];
+
+        if (child->leaf) {
+            // the separator is copied up and stays in the right leaf
+            newRightChild->keys.assign(child->keys.begin() + middleIndex, child->keys.end());
+            child->keys.resize(middleIndex);
+        } else {
+            // the separator moves up to the parent, pending messages follow their subtrees
+            newRightChild->keys.assign(child->keys.begin() + middleIndex + 1, child->keys.end());
+            newRightChild->children.assign(child->children.begin() + middleIndex + 1, child->children.end());
+            for (int i = middleIndex + 1; i < child->buffers.size(); i++) {
+                newRightChild->buffers.push_back(vector<message>());
+                newRightChild->buffers.back().swap(child->buffers[i]);
+                newRightChild->buffered += newRightChild->buffers.back().size();
+            }
+            child->buffered -= newRightChild->buffered;
+            child->keys.resize(middleIndex);
+            child->children.resize(middleIndex + 1);
+            child->buffers.resize(middleIndex + 1);
+        }
+
+        // the messages of the parent for the old child are split by the separator
+        vector<message> &old = parent->buffers[parentIndex];
+        vector<message> right;
+        int kept = 0;
+        for (int i = 0; i < old.size(); i++) {
+            if (old[i].key < separator)
+                old[kept++] = old[i];
+            else
+                right.push_back(old[i]);
+        }
+        old.resize(kept);
+        parent->keys.insert(parent->keys.begin() + parentIndex, separator);
+        parent->children.insert(parent->children.begin() + parentIndex + 1, newRightChild);
+        parent->buffers.insert(parent->buffers.begin() + parentIndex + 1, vector<message>());
+        parent->buffers[parentIndex + 1].swap(right);
+    }
+
+    // Split the child at the given index and all the siblings created from it until none of them is too big.
+    void divide_too_big_children(bf_node *parent, int parentIndex) {
+        int last = parentIndex;
+        for (int i = parentIndex; i <= last;) {
+            if (parent->children[i]->keys.size() >= this->b) {
+                this->divide_child(parent, i);
+                last++;
+            } else {
+                i++;
+            }
+        }
+    }
+
+    // Send a message to the root and restore the invariants.
+    void push_message(const message &m) {
+        if (root->leaf) {
+            this->apply_to_leaf(root, m);
+        } else {
+            root->buffer_message(m);
+            if (root->buffered > this->buffer_size)
+                this->flush(root);
+        }
+
+        // fixing potencial too big the root
+        while (root->keys.size() >= this->b) {
+            bf_node *newRoot = this->new_node(false);
+            newRoot->children.push_back(root);
+            newRoot->buffers.push_back(vector<message>());
+            this->divide_too_big_children(newRoot, 0);
+            root = newRoot;
+        }
+    }
+
+   public:
+    // Constructor: initialize an empty tree with just the root.
+    // Every internal node buffers up to buffer_size messages. A flush moves
+    // about buffer_size / b messages at once, so the buffer should be several
+    // times larger than b for batching to pay off.
+    buffered_ab_tree(int a, int b, int buffer_size) {
+        EXPECT(a >= 2 && b >= 2 * a - 1, "Invalid values of a,b");
+        EXPECT(buffer_size >= 1, "Invalid buffer size");
+        this->a = a;
+        this->b = b;
+        this->buffer_size = buffer_size;
+        num_nodes = 0;
+        // The root is an empty leaf.
+        root = new_node(true);
+    }
+
+    // Find a key: returns true if it is present in the tree.
+    // Buffers closer to the root hold newer messages, so the first message found decides.
+    bool find(int key) {
+        bf_node *n = root;
+        while (!n->leaf) {
+            int c = n->find_child(key);
+            const vector<message> &buffer = n->buffers[c];
+            for (int i = buffer.size() - 1; i >= 0; i--)
+                if (buffer[i].key == key)
+                    return !buffer[i].remove;
+            n = n->children[c];
+        }
+        int i = n->find_position(key);
+        return i < n->keys.size() && n->keys[i] == key;
+    }
+
+    // Insert: add key to the tree (unless it was already present).
+    void insert(int key) {
+        this->push_message({key, false});
+    }
+
+    // remove: remove key from the tree (unless it doesnt exist in the tree).
+    // Nodes are not merged, so leaves may become underfull.
+    void remove(int key) {
+        this->push_message({key, true});
+    }
+
+    // Destructor: delete all nodes.
+    ~buffered_ab_tree() {
+        this->delete_tree(root);
+        EXPECT(num_nodes == 0, "Memory leak detected: some nodes were not deleted");
+    }
+};
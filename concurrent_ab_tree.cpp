@@ -0,0 +1,297 @@
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+using namespace std;
+
+// If the condition is not true, report an error and halt.
+#define EXPECT(condition, message)                \
+    do {                                          \
+        if (!(condition)) expect_failed(message); \
+    } while (0)
+
+void expect_failed(const string &message);
+
+/*** Tree ***/
+
+// Thread-safe (a,b)-tree with optimistic lock coupling.
+// Every node has a version lock. Readers never write to shared memory: they
+// remember the version of a node, read it, and validate that the version did
+// not change, restarting the operation otherwise. Writers lock only the nodes
+// they modify, i.e. the bottom node receiving the key, or a full node being
+// split together with its parent.
+// Full nodes are split on the way down (instead of on the way back up as in
+// ab_tree), so the parent of a split node always has room and no lock is held
+// for more than one level. That needs one key of slack, so we require b >= 2a.
+// Nodes are never freed while the tree is in use, so a reader holding a stale
+// pointer may only read a stale node, which the validation catches.
+class concurrent_ab_tree {
+   private:
+    /*** One node ***/
+
+    class ab_node {
+       public:
+        // Version lock: bit 1 is set while the node is locked for writing
+        // and the version grows by 2 with every unlock.
+        atomic<uint64_t> version;
+        // Keys stored in this node and the corresponding children.
+        // The arrays have a fixed size (b-1 keys and b children) and start zeroed,
+        // so a reader racing with a writer can read stale values, but never
+        // uninitialized ones or outside the node.
+        // Readers race with writers, so all fields are atomic. Relaxed accesses
+        // are enough, the ordering is provided by the version lock.
+        atomic<int> num_keys;
+        atomic<int> *keys;
+        atomic<ab_node *> *children;
+
+        int get_num_keys() { return num_keys.load(memory_order_relaxed); }
+        void set_num_keys(int n) { num_keys.store(n, memory_order_relaxed); }
+        int get_key(int i) { return keys[i].load(memory_order_relaxed); }
+        void set_key(int i, int key) { keys[i].store(key, memory_order_relaxed); }
+        ab_node *get_child(int i) { return children[i].load(memory_order_relaxed); }
+        void set_child(int i, ab_node *child) { children[i].store(child, memory_order_relaxed); }
+
+        // If this node contains the given key, return true and set i to key's position.
+        // Otherwise return false and set i to the first key greater than the given one.
+        bool find_branch(int key, int &i, int max_keys) {
+            int n = get_num_keys();
+            if (n > max_keys) n = max_keys;  // only possible for an inconsistent read
+            if (n < 0) n = 0;
+            i = 0;
+            while (i < n) {
+                int k = get_key(i);
+                if (k > key)
+                    break;
+                if (k == key)
+                    return true;
+                i++;
+            }
+            return false;
+        }
+
+        // Insert a new key at posision i and add a new child between keys i and i+1.
+        void insert_branch(int i, int key, ab_node *child) {
+            int n = get_num_keys();
+            for (int j = n; j > i; j--) {
+                set_key(j, get_key(j - 1));
+                set_child(j + 1, get_child(j));
+            }
+            set_key(i, key);
+            set_child(i + 1, child);
+            set_num_keys(n + 1);
+        }
+
+        // Return the current version, or set restart if the node is locked.
+        uint64_t read_lock_or_restart(bool &restart) {
+            uint64_t v = version.load();
+            if (v & 2)
+                restart = true;
+            return v;
+        }
+
+        // Set restart if the node changed since version v was read.
+        // The fence keeps the optimistic reads of the node before the validation.
+        void check_or_restart(uint64_t v, bool &restart) {
+            atomic_thread_fence(memory_order_acquire);
+            if (version.load(memory_order_relaxed) != v)
+                restart = true;
+        }
+
+        // Lock the node, provided it did not change since version v was read.
+        void upgrade_to_write_lock_or_restart(uint64_t v, bool &restart) {
+            if (!version.compare_exchange_strong(v, v + 2))
+                restart = true;
+            else
+                atomic_thread_fence(memory_order_release);  // the lock is visible before any change
+        }
+
+        void write_unlock() {
+            version.fetch_add(2);
+        }
+    };
+
+    int a;                  // Minimum allowed number of children
+    int b;                  // Maximum allowed number of children
+    atomic<ab_node *> root;  // Root node (even a tree with no keys has a root)
+    atomic<int> num_nodes;  // We keep track of how many nodes the tree has
+
+    // Create a new node and return a pointer to it.
+    ab_node *new_node() {
+        ab_node *n = new ab_node;
+        n->version.store(0);
+        n->set_num_keys(0);
+        n->keys = new atomic<int>[b - 1]();
+        n->children = new atomic<ab_node *>[b]();
+        n->set_child(0, nullptr);
+        num_nodes++;
+        return n;
+    }
+
+    // Delete a given node, assuming that its children have been already unlinked.
+    void delete_node(ab_node *n) {
+        num_nodes--;
+        delete[] n->keys;
+        delete[] n->children;
+        delete n;
+    }
+
+    // An auxiliary function for deleting a subtree recursively.
+    void delete_tree(ab_node *n) {
+        for (int i = 0; i <= n->get_num_keys(); i++)
+            if (n->get_child(i))
+                delete_tree(n->get_child(i));
+        delete_node(n);
+    }
+
+    // Split a full locked node in place: its upper half moves to a new right
+    // sibling, which is linked to the locked parent (or to a new root).
+    void divide_full_child(int parentIndex, ab_node *parent, ab_node *child) {
+        int middleIndex = (this->b - 1) / 2;
+        ab_node *newRightChild = this->new_node();
+        int rightKeys = child->get_num_keys() - middleIndex - 1;
+        for (int i = 0; i < rightKeys; i++) {
+            newRightChild->set_key(i, child->get_key(middleIndex + 1 + i));
+            newRightChild->set_child(i, child->get_child(middleIndex + 1 + i));
+        }
+        newRightChild->set_child(rightKeys, child->get_child(child->get_num_keys()));
+        newRightChild->set_num_keys(rightKeys);
+        child->set_num_keys(middleIndex);
+
+        if (parent) {  // it is called for inner node
+            parent->insert_branch(parentIndex, child->get_key(middleIndex), newRightChild);
+        } else {  // it is called for the root and the root does not have a parent
+            ab_node *newRoot = this->new_node();
+            newRoot->set_num_keys(1);
+            newRoot->set_key(0, child->get_key(middleIndex));
+            newRoot->set_child(0, child);
+            newRoot->set_child(1, newRightChild);
+            this->root.store(newRoot);
+        }
+    }
+
+    // One optimistic attempt of find. Returns false if it has to be restarted.
+    bool try_find(int key, bool &found) {
+        bool restart = false;
+        ab_node *node = root.load();
+        uint64_t v = node->read_lock_or_restart(restart);
+        if (restart || node != root.load())
+            return false;
+
+        while (true) {
+            int i;
+            found = node->find_branch(key, i, b - 1);
+            ab_node *child = node->get_child(i);
+            node->check_or_restart(v, restart);
+            if (restart)
+                return false;
+            if (found || !child)
+                return true;
+
+            uint64_t childVersion = child->read_lock_or_restart(restart);
+            node->check_or_restart(v, restart);
+            if (restart)
+                return false;
+            node = child;
+            v = childVersion;
+        }
+    }
+
+    // One optimistic attempt of insert. Returns false if it has to be restarted.
+    bool try_insert(int key) {
+        bool restart = false;
+        ab_node *node = root.load();
+        uint64_t v = node->read_lock_or_restart(restart);
+        if (restart || node != root.load())
+            return false;
+        ab_node *parent = nullptr;
+        uint64_t parentVersion = 0;
+        int parentIndex = 0;
+
+        while (true) {
+            // split a full node preemptively, so that its parent never overflows
+            if (node->get_num_keys() == this->b - 1) {
+                if (parent) {
+                    parent->upgrade_to_write_lock_or_restart(parentVersion, restart);
+                    if (restart)
+                        return false;
+                }
+                node->upgrade_to_write_lock_or_restart(v, restart);
+                if (restart || (!parent && node != root.load())) {
+                    if (!restart) node->write_unlock();
+                    if (parent) parent->write_unlock();
+                    return false;
+                }
+                this->divide_full_child(parentIndex, parent, node);
+                node->write_unlock();
+                if (parent) parent->write_unlock();
+                return false;  // start again from the (possibly new) root
+            }
+            if (parent) {
+                parent->check_or_restart(parentVersion, restart);
+                if (restart)
+                    return false;
+            }
+
+            int i;
+            bool found = node->find_branch(key, i, b - 1);
+            ab_node *child = node->get_child(i);
+            node->check_or_restart(v, restart);
+            if (restart)
+                return false;
+            if (found)
+                return true;
+
+            if (child == nullptr) {  // we are in the last internal node, deeper is only nullptr leaf
+                node->upgrade_to_write_lock_or_restart(v, restart);
+                if (restart)
+                    return false;
+                node->insert_branch(i, key, nullptr);
+                node->write_unlock();
+                return true;
+            }
+
+            uint64_t childVersion = child->read_lock_or_restart(restart);
+            node->check_or_restart(v, restart);
+            if (restart)
+                return false;
+            parent = node;
+            parentVersion = v;
+            parentIndex = i;
+            node = child;
+            v = childVersion;
+        }
+    }
+
+   public:
+    // Constructor: initialize an empty tree with just the root.
+    concurrent_ab_tree(int a, int b) {
+        EXPECT(a >= 2 && b >= 2 * a, "Invalid values of a,b");
+        this->a = a;
+        this->b = b;
+        num_nodes.store(0);
+        // The root has no keys and one null child pointer.
+        root.store(new_node());
+    }
+
+    // Find a key: returns true if it is present in the tree.
+    bool find(int key) {
+        bool found;
+        while (!this->try_find(key, found))
+            ;
+        return found;
+    }
+
+    // Insert: add key to the tree (unless it was already present).
+    void insert(int key) {
+        while (!this->try_insert(key))
+            ;
+    }
+
+    // Destructor: delete all nodes. No other thread may use the tree anymore.
+    ~concurrent_ab_tree() {
+        this->delete_tree(root.load());
+        EXPECT(num_nodes.load() == 0, "Memory leak detected: some nodes were not deleted");
+    }
+};
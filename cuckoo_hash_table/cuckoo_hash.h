@@ -45,8 +45,8 @@ class CuckooTable {
     }
 
     void refresh_function() {
-        delete this->random_gen;
-        this->random_gen = new RandomGen(rand());
+        // a jump gives a fresh stream which does not overlap the previous ones
+        this->random_gen->jump();
         for (int i = 0; i < 2; i++) {
             delete this->hashes[i];
             this->hashes[i] = new TabulationHash(this->num_buckets, this->random_gen);
@@ -1,21 +1,70 @@
+#ifndef DS1_RANDOM_H
 #define DS1_RANDOM_H
 
+#include <cstddef>
 #include <cstdint>
 
 class RandomGen {
+    // Number of independent lanes advanced together by fill()
+    static const int LANES = 4;
+
     uint64_t state[2];
 
+    // States of the lanes used by fill(). Lane 0 is the main state,
+    // lane k starts k * 2^62 steps ahead of it.
+    uint64_t lane_state[2][LANES];
+    bool lanes_ready;
+
+    // Values of the last block of fill() which were not returned yet:
+    // pending[pending_next], ..., pending[LANES-1].
+    uint64_t pending[LANES];
+    int pending_next;
+
     uint64_t rotl(uint64_t x, int k)
     {
         return (x << k) | (x >> (64 - k));
     }
 
+    // Advance the state by the number of steps given by a jump polynomial.
+    void jump_by(const uint64_t polynomial[2])
+    {
+        uint64_t s0 = 0, s1 = 0;
+        for (int i = 0; i < 2; i++)
+            for (int b = 0; b < 64; b++) {
+                if (polynomial[i] & (uint64_t)1 << b) {
+                    s0 ^= this->state[0];
+                    s1 ^= this->state[1];
+                }
+                next_u64();
+            }
+        this->state[0] = s0;
+        this->state[1] = s1;
+        this->lanes_ready = false;
+    }
+
+    // Place the lanes 2^62 steps apart, starting at the main state.
+    void init_lanes(void)
+    {
+        static const uint64_t JUMP_62[2] = { 0xc78fe2a8ab69f8f8, 0x8019f0cf875b640e };
+        uint64_t s0 = this->state[0], s1 = this->state[1];
+        for (int k = 0; k < LANES; k++) {
+            this->lane_state[0][k] = this->state[0];
+            this->lane_state[1][k] = this->state[1];
+            jump_by(JUMP_62);
+        }
+        this->state[0] = s0;
+        this->state[1] = s1;
+        this->lanes_ready = true;
+        this->pending_next = LANES;
+    }
+
   public:
     // Initialize the generator, set its seed and warm it up.
     RandomGen(unsigned int seed)
     {
         this->state[0] = seed * 0xdeadbeef;
         this->state[1] = seed ^ 0xc0de1234;
+        this->lanes_ready = false;
         for (int i=0; i<100; i++)
             next_u64();
     }
@@ -47,5 +96,79 @@ class RandomGen {
          */
         return next_u64() % range;
     }
+
+    // Advance the generator by 2^64 steps. Copies of one generator with
+    // 0, 1, 2, ... jumps give non-overlapping streams, e.g. one per thread.
+    void jump(void)
+    {
+        static const uint64_t JUMP[2] = { 0xbeac0467eba5facb, 0xd86b048b86aa9922 };
+        jump_by(JUMP);
+    }
+
+    // Advance the generator by 2^96 steps. Use it to separate groups of
+    // streams which are themselves created by jump().
+    void long_jump(void)
+    {
+        static const uint64_t LONG_JUMP[2] = { 0x18f7c399ccebda8d, 0xf2deac28bef3bb07 };
+        jump_by(LONG_JUMP);
+    }
+
+    // Fill the array with n random 64-bit numbers. Several lanes of the
+    // generator are advanced together, which the compiler can vectorize.
+    // The lanes are parts of this generator's stream 2^62 steps apart,
+    // so the output does not overlap with other streams created by jump().
+    // Values of a partly used block are kept for the next call, so the
+    // output does not depend on how it is split into calls; jump() and
+    // long_jump() discard them.
+    // The lane loop is only vectorized by GCC with -O3 (or -ftree-vectorize);
+    // with plain -O2 it stays scalar and is no faster than next_u64().
+    void fill(uint64_t *out, size_t n)
+    {
+        if (!this->lanes_ready)
+            init_lanes();
+        size_t i = 0;
+        while (i < n && this->pending_next < LANES)
+            out[i++] = this->pending[this->pending_next++];
+        if (i == n)
+            return;
+
+        uint64_t s0[LANES], s1[LANES];
+        for (int k = 0; k < LANES; k++) {
+            s0[k] = this->lane_state[0][k];
+            s1[k] = this->lane_state[1][k];
+        }
+        // lane 0 continues the main stream
+        s0[0] = this->state[0];
+        s1[0] = this->state[1];
+
+        while (i < n) {
+            uint64_t block[LANES];
+            for (int k = 0; k < LANES; k++) {
+                uint64_t a = s0[k], b = s1[k] ^ s0[k];
+                block[k] = a + s1[k];
+                s0[k] = rotl(a, 55) ^ b ^ (b << 14);
+                s1[k] = rotl(b, 36);
+            }
+            if (n - i >= LANES) {
+                for (int k = 0; k < LANES; k++)
+                    out[i + k] = block[k];
+                i += LANES;
+            } else {
+                int k = 0;
+                while (i < n)
+                    out[i++] = block[k++];
+                for (this->pending_next = k; k < LANES; k++)
+                    this->pending[k] = block[k];
+            }
+        }
+
+        for (int k = 0; k < LANES; k++) {
+            this->lane_state[0][k] = s0[k];
+            this->lane_state[1][k] = s1[k];
+        }
+        this->state[0] = s0[0];
+        this->state[1] = s1[0];
+    }
 };
 
+#endif
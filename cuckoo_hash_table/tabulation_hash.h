@@ -17,9 +17,11 @@ class TabulationHash {
    public:
     TabulationHash(uint32_t num_buckets, RandomGen *random_gen) {
         this->num_buckets = num_buckets;
+        uint64_t values[4 * 256];
+        random_gen->fill(values, 4 * 256);
         for (int i = 0; i < 4; i++)
             for (int j = 0; j < 256; j++)
-                this->tables[i][j] = random_gen->next_u32();
+                this->tables[i][j] = values[i * 256 + j] >> 32;
     }
 
     uint32_t hash(uint32_t key) {
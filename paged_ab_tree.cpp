@@ -0,0 +1,356 @@
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+// If the condition is not true, report an error and halt.
+#define EXPECT(condition, message)                \
+    do {                                          \
+        if (!(condition)) expect_failed(message); \
+    } while (0)
+
+void expect_failed(const string &message);
+
+/*** Tree ***/
+
+// Disk-backed (a,b)-tree. Every node is stored in one fixed-size page of a file
+// and b is the largest value for which a node (including the one extra entry
+// of an overflowing node) fits into a page. Pages are accessed through a bounded
+// buffer pool with clock eviction and dirty-page write-back, so hot nodes are
+// served from memory. Page 0 holds the header, so the tree can be reopened later.
+class paged_ab_tree {
+   private:
+    static const uint32_t MAGIC = 0xab7ee001;
+    static const uint32_t NO_PAGE = 0;  // Page 0 is the header, so it never holds a node
+    static const int NODE_HEADER = 8;   // Number of keys and padding
+
+    /*** One node stored in a page ***/
+
+    class page_node {
+       public:
+        // Pointers into the page: the number of keys, then space for b keys
+        // and b+1 child page numbers (NO_PAGE for missing children).
+        uint32_t *num_keys;
+        int32_t *keys;
+        uint32_t *children;
+
+        page_node(char *page, int b) {
+            num_keys = (uint32_t *)page;
+            keys = (int32_t *)(page + NODE_HEADER);
+            children = (uint32_t *)(page + NODE_HEADER + 4 * b);
+        }
+
+        // If this node contains the given key, return true and set i to key's position.
+        // Otherwise return false and set i to the first key greater than the given one.
+        bool find_branch(int key, int &i) {
+            i = 0;
+            while (i < *num_keys && keys[i] <= key) {
+                if (keys[i] == key)
+                    return true;
+                i++;
+            }
+            return false;
+        }
+
+        // Insert a new key at posision i and add a new child between keys i and i+1.
+        void insert_branch(int i, int key, uint32_t child) {
+            memmove(keys + i + 1, keys + i, 4 * (*num_keys - i));
+            memmove(children + i + 2, children + i + 1, 4 * (*num_keys - i));
+            keys[i] = key;
+            children[i + 1] = child;
+            (*num_keys)++;
+        }
+    };
+
+    /*** Buffer pool ***/
+
+    class buffer_pool {
+        class frame {
+           public:
+            uint32_t page_id;  // NO_PAGE if the frame is free
+            int pin_count;     // Pinned frames are never evicted
+            bool dirty;        // The page has to be written back before eviction
+            bool referenced;   // Second chance bit for the clock
+        };
+
+        fstream *file;
+        int page_size;
+        vector<char> memory;  // One page per frame
+        vector<frame> frames;
+        unordered_map<uint32_t, int> page_table;  // Page number -> frame
+        int clock_hand;
+
+        char *frame_data(int f) {
+            return &memory[(size_t)f * page_size];
+        }
+
+        void write_frame(int f) {
+            file->seekp((streamoff)frames[f].page_id * page_size);
+            file->write(frame_data(f), page_size);
+            EXPECT(file->good(), "Writing a page failed");
+            frames[f].dirty = false;
+            page_writes++;
+        }
+
+        void read_frame(int f) {
+            file->seekg((streamoff)frames[f].page_id * page_size);
+            file->read(frame_data(f), page_size);
+            EXPECT(file->good(), "Reading a page failed");
+            page_reads++;
+        }
+
+        // Find a frame for a new page: a free one, or an unpinned page
+        // which was not referenced since the clock hand passed it last time.
+        int find_victim() {
+            for (int step = 0; step < 2 * frames.size(); step++) {
+                int f = clock_hand;
+                clock_hand = (clock_hand + 1) % frames.size();
+                if (frames[f].page_id == NO_PAGE)
+                    return f;
+                if (frames[f].pin_count > 0)
+                    continue;
+                if (frames[f].referenced) {
+                    frames[f].referenced = false;
+                    continue;
+                }
+                if (frames[f].dirty)
+                    write_frame(f);
+                page_table.erase(frames[f].page_id);
+                return f;
+            }
+            expect_failed("Buffer pool is too small: all pages are pinned");
+            return -1;
+        }
+
+       public:
+        // Statistics
+        long long hits;
+        long long misses;
+        long long page_reads;
+        long long page_writes;
+
+        buffer_pool(fstream *file, int page_size, int num_frames) {
+            this->file = file;
+            this->page_size = page_size;
+            memory.resize((size_t)num_frames * page_size);
+            frames.resize(num_frames, {NO_PAGE, 0, false, false});
+            clock_hand = 0;
+            hits = misses = page_reads = page_writes = 0;
+        }
+
+        // Pin the given page in memory and return its data. A fresh page
+        // is not read from the file, it starts zeroed instead.
+        char *fetch(uint32_t page_id, bool fresh = false) {
+            auto it = page_table.find(page_id);
+            if (it != page_table.end()) {
+                hits++;
+                frame &fr = frames[it->second];
+                fr.pin_count++;
+                fr.referenced = true;
+                return frame_data(it->second);
+            }
+
+            misses++;
+            int f = find_victim();
+            frames[f] = {page_id, 1, fresh, true};
+            page_table[page_id] = f;
+            if (fresh)
+                memset(frame_data(f), 0, page_size);
+            else
+                read_frame(f);
+            return frame_data(f);
+        }
+
+        // Release a page pinned by fetch, marking it dirty if it was modified.
+        void unpin(uint32_t page_id, bool dirty) {
+            frame &fr = frames[page_table.at(page_id)];
+            fr.pin_count--;
+            fr.dirty |= dirty;
+        }
+
+        // Write all dirty pages back to the file.
+        void flush() {
+            for (int f = 0; f < frames.size(); f++)
+                if (frames[f].page_id != NO_PAGE && frames[f].dirty)
+                    write_frame(f);
+        }
+    };
+
+    int a;              // Minimum allowed number of children
+    int b;              // Maximum allowed number of children
+    int page_size;      // Size of one page in bytes
+    uint32_t root;      // Page of the root node (even a tree with no keys has a root)
+    uint32_t num_pages;  // Number of pages in the file including the header
+    fstream file;
+    buffer_pool *pool;
+
+    // Allocate a new page for a node and return its number. The page stays pinned.
+    uint32_t new_node(char *&page) {
+        uint32_t page_id = num_pages++;
+        page = pool->fetch(page_id, true);
+        return page_id;
+    }
+
+    void write_header() {
+        vector<char> header(page_size, 0);
+        uint32_t fields[4] = {MAGIC, (uint32_t)page_size, root, num_pages};
+        memcpy(header.data(), fields, sizeof(fields));
+        file.seekp(0);
+        file.write(header.data(), page_size);
+        EXPECT(file.good(), "Writing the header failed");
+    }
+
+    // Insert the key into the subtree of the given node, whose page is pinned
+    // by the caller and stays pinned, so that the caller can split the node
+    // without fetching it again. Returns true if the page was modified.
+    bool recursive_insert(int key, char *page) {
+        // finding node
+        page_node node(page, b);
+        int index;
+        if (node.find_branch(key, index))
+            return false;
+
+        uint32_t child = node.children[index];
+
+        if (child == NO_PAGE) {                         // we are in the last internal node, deeper is only nullptr leaf
+            node.insert_branch(index, key, NO_PAGE);  // insert the new node
+            return true;
+        }
+
+        // we need to go deeper for finding or inserting the new node
+        char *child_page = pool->fetch(child);
+        bool child_modified = this->recursive_insert(key, child_page);
+
+        // fixing potencial too big child of node
+        bool divided = this->divide_too_big_child(index, &node, child, child_page);
+        pool->unpin(child, child_modified || divided);
+        return divided;
+    }
+
+    // Split an overflowing child in place: its upper half moves to a new page.
+    // The child page is pinned by the caller. Returns true if the child was split,
+    // in which case both the child and the parent were modified.
+    bool divide_too_big_child(int parentIndex, page_node *parent, uint32_t child_id, char *child_page) {
+        page_node child(child_page, b);
+        if (*child.num_keys < this->b)
+            return false;
+
+        int middleIndex = (this->b - 1) / 2;
+        int separator = child.keys[middleIndex];
+        char *right_page;
+        uint32_t right_id = this->new_node(right_page);
+        page_node newRightChild(right_page, b);
+        *newRightChild.num_keys = this->b - middleIndex - 1;
+        memcpy(newRightChild.keys, child.keys + middleIndex + 1, 4 * *newRightChild.num_keys);
+        memcpy(newRightChild.children, child.children + middleIndex + 1, 4 * (*newRightChild.num_keys + 1));
+        *child.num_keys = middleIndex;
+
+        if (parent) {  // it is called for inner node
+            parent->insert_branch(parentIndex, separator, right_id);
+        } else {  // it is called for the root and the root does not have a parent
+            char *root_page;
+            uint32_t root_id = this->new_node(root_page);
+            page_node newRoot(root_page, b);
+            *newRoot.num_keys = 1;
+            newRoot.keys[0] = separator;
+            newRoot.children[0] = child_id;
+            newRoot.children[1] = right_id;
+            this->root = root_id;
+            pool->unpin(root_id, true);
+        }
+        pool->unpin(right_id, true);
+        return true;
+    }
+
+   public:
+    // Constructor: open the tree stored in the given file, or create an empty one
+    // if the file is empty or does not exist. At most pool_pages pages are cached.
+    paged_ab_tree(const string &path, int page_size = 4096, int pool_pages = 1024) {
+        EXPECT(page_size >= 64 && page_size % 8 == 0, "Invalid page size");
+        EXPECT(pool_pages >= 16, "Buffer pool is too small");
+        this->page_size = page_size;
+        this->b = (page_size - NODE_HEADER - 4) / 8;
+        this->a = (this->b + 1) / 2;
+
+        file.open(path, ios::in | ios::out | ios::binary);
+        if (!file.is_open()) {
+            file.open(path, ios::out | ios::binary);
+            file.close();
+            file.open(path, ios::in | ios::out | ios::binary);
+        }
+        EXPECT(file.is_open(), "Cannot open the tree file");
+        pool = new buffer_pool(&file, page_size, pool_pages);
+
+        file.seekg(0, ios::end);
+        if (file.tellg() == 0) {
+            // The root has no keys and one null child pointer.
+            num_pages = 1;
+            char *page;
+            root = new_node(page);
+            pool->unpin(root, true);
+            write_header();
+        } else {
+            uint32_t fields[4];
+            file.seekg(0);
+            file.read((char *)fields, sizeof(fields));
+            EXPECT(file.good() && fields[0] == MAGIC, "The file does not contain a tree");
+            EXPECT(fields[1] == page_size, "The tree was stored with a different page size");
+            root = fields[2];
+            num_pages = fields[3];
+        }
+    }
+
+    // Find a key: returns true if it is present in the tree.
+    bool find(int key) {
+        uint32_t n = root;
+        while (n != NO_PAGE) {
+            page_node node(pool->fetch(n), b);
+            int i;
+            bool found = node.find_branch(key, i);
+            uint32_t child = node.children[i];
+            pool->unpin(n, false);
+            if (found)
+                return true;
+            n = child;
+        }
+        return false;
+    }
+
+    // Insert: add key to the tree (unless it was already present).
+    void insert(int key) {
+        uint32_t root_id = this->root;
+        char *page = pool->fetch(root_id);
+        bool modified = this->recursive_insert(key, page);
+        // fixing potencial too big the root
+        bool divided = this->divide_too_big_child(0, nullptr, root_id, page);
+        pool->unpin(root_id, modified || divided);
+    }
+
+    // Write all dirty pages and the header to the file.
+    void flush() {
+        pool->flush();
+        write_header();
+        file.flush();
+    }
+
+    // Statistics of the buffer pool
+    long long pool_hits() { return pool->hits; }
+    long long pool_misses() { return pool->misses; }
+    long long page_reads() { return pool->page_reads; }
+    long long page_writes() { return pool->page_writes; }
+    double hit_rate() {
+        long long total = pool->hits + pool->misses;
+        return total ? (double)pool->hits / total : 0;
+    }
+
+    // Destructor: write everything back and close the file.
+    ~paged_ab_tree() {
+        this->flush();
+        delete pool;
+    }
+};
@@ -1,5 +1,29 @@
+#include <climits>
+#include <string>
+
+#include "cuckoo_hash_table/random_gen.h"
+
+using namespace std;
+
+// If the condition is not true, report an error and halt.
+#define EXPECT(condition, message)                \
+    do {                                          \
+        if (!(condition)) expect_failed(message); \
+    } while (0)
+
+void expect_failed(const string &message);
+
 // Splay tree
 class SplayTree {
+   public:
+    // How lookup restructures the tree. Insert and remove always splay fully.
+    enum SplayPolicy {
+        FULL_SPLAY,       // splay the found node to the root
+        SEMI_SPLAY,       // semi-splaying: a zig-zig step lifts only the parent
+        DEPTH_THRESHOLD,  // splay only if the node is deeper than the policy parameter
+        PROBABILISTIC,    // splay with probability 1/k, k is the policy parameter
+    };
+
    private:
     // A node of the tree
     class Node {
@@ -23,11 +47,22 @@ class SplayTree {
     // Pointer to root of the tree; nullptr if the tree is empty.
     Node* root;
 
+    // Splay policy of lookup, its parameter and the seeded generator
+    // deciding about splaying under the PROBABILISTIC policy
+    SplayPolicy policy;
+    int policy_parameter;
+    RandomGen random_gen;
+
+    // Statistics
+    long long rotations;
+    long long operations;
+
     // Rotate the given `node` up. Perform a single rotation of the edge
     // between the node and its parent, choosing left or right rotation
     // appropriately.
     void rotate(Node* node) {
         if (node->parent) {
+            rotations++;
             if (node->parent->left == node) {
                 if (node->right) node->right->parent = node->parent;
                 node->parent->left = node->right;
@@ -70,15 +105,55 @@ class SplayTree {
         }
     }
 
-   public:
-    // Constructor for Splay tree
-    SplayTree(Node* root = nullptr) {
-        this->root = root;
+    // Semi-splay the given node: a zig-zig step rotates only the parent and
+    // continues from it, so the path is roughly halved with fewer rotations.
+    void semi_splay(Node* x) {
+        while (x && x != this->root) {
+            if (!x->parent->parent) {
+                this->rotate(x);
+                break;
+            }
+            Node* y = x->parent;
+            Node* z = y->parent;
+            // zig-zig rotation
+            if ((z->left == y && y->left == x) || (z->right == y && y->right == x)) {
+                this->rotate(y);
+                x = y;
+            }
+            // zig-zag rotation
+            else {
+                this->rotate(x);
+                this->rotate(x);
+            }
+        }
     }
-    // Look up the given key in the tree, returning the
-    // the node with the requested key or nullptr.
-    Node* lookup(int key) {
+
+    // Restructure the tree after a lookup reached the given node at the given depth.
+    void splay_after_lookup(Node* x, int depth) {
+        switch (policy) {
+            case FULL_SPLAY:
+                this->splay(x);
+                break;
+            case SEMI_SPLAY:
+                this->semi_splay(x);
+                break;
+            case DEPTH_THRESHOLD:
+                if (depth > policy_parameter)
+                    this->splay(x);
+                break;
+            case PROBABILISTIC:
+                if (random_gen.next_range(policy_parameter) == 0)
+                    this->splay(x);
+                break;
+        }
+    }
+
+    // Find the node with the given key, or the last node on the search path
+    // if the key is not present. Returns nullptr for an empty tree.
+    // If depth is given, it is set to the depth of the returned node.
+    Node* descend(int key, int* depth = nullptr) {
         Node* node = root;
+        int d = 0;
         while (node && node->key != key) {
             if (key < node->key && node->left)
                 node = node->left;
@@ -86,14 +161,76 @@ class SplayTree {
                 node = node->right;
             else
                 break;
+            d++;
         }
+        if (depth) *depth = d;
+        return node;
+    }
+
+    // Splay the node with the maximum key.
+    void splay_max() {
+        Node* node = root;
+        while (node && node->right)
+            node = node->right;
+        this->splay(node);
+    }
+
+    // Splay the node with the minimum key.
+    void splay_min() {
+        Node* node = root;
+        while (node && node->left)
+            node = node->left;
         this->splay(node);
-        return node->key == key ? node : nullptr;
+    }
+
+   public:
+    // Constructor for Splay tree
+    SplayTree(Node* root = nullptr) : random_gen(1) {
+        this->root = root;
+        this->policy = FULL_SPLAY;
+        this->policy_parameter = 0;
+        this->rotations = 0;
+        this->operations = 0;
+    }
+
+    // Choose how lookup splays. The parameter is the depth threshold for
+    // DEPTH_THRESHOLD and k for PROBABILISTIC, other policies ignore it.
+    // The seed makes the PROBABILISTIC policy reproducible.
+    void set_splay_policy(SplayPolicy policy, int parameter = 0, unsigned int seed = 1) {
+        EXPECT(policy != PROBABILISTIC || parameter > 0, "Splay probability 1/k needs k > 0");
+        this->policy = policy;
+        this->policy_parameter = parameter;
+        this->random_gen = RandomGen(seed);
+    }
+
+    // The tree owns its nodes, so it cannot be copied.
+    SplayTree(const SplayTree&) = delete;
+    SplayTree& operator=(const SplayTree&) = delete;
+
+    // Statistics: rotations and lookups, inserts and removes since the last reset.
+    // Split, join and the range operations built on them are not counted.
+    long long rotation_count() { return rotations; }
+    long long operation_count() { return operations; }
+    double rotations_per_operation() { return operations ? (double)rotations / operations : 0; }
+    void reset_counters() {
+        rotations = 0;
+        operations = 0;
+    }
+
+    // Look up the given key in the tree, returning the
+    // the node with the requested key or nullptr.
+    Node* lookup(int key) {
+        operations++;
+        int depth;
+        Node* node = this->descend(key, &depth);
+        this->splay_after_lookup(node, depth);
+        return node && node->key == key ? node : nullptr;
     }
 
     // Insert a key into the tree.
     // If the key is already present, nothing happens.
     void insert(int key) {
+        operations++;
         if (!root) {
             root = new Node(key);
             return;
@@ -117,15 +254,8 @@ class SplayTree {
     // Delete given key from the tree.
     // It the key is not present, nothing happens.
     void remove(int key) {
-        Node* node = root;
-        while (node && node->key != key) {
-            if (key < node->key && node->left)
-                node = node->left;
-            else if (key > node->key && node->right)
-                node = node->right;
-            else
-                break;
-        }
+        operations++;
+        Node* node = this->descend(key);
 
         if (node && node->key == key) {
             if (node->left && node->right) {
@@ -155,6 +285,101 @@ class SplayTree {
             this->splay(node);
     }
 
+    // Move all keys greater or equal to the given key into the empty tree `right`.
+    void split(int key, SplayTree& right) {
+        EXPECT(!right.root, "The tree receiving the split keys must be empty");
+        Node* node = this->descend(key);
+        if (!node)
+            return;
+        long long counted = rotations;
+        this->splay(node);
+        rotations = counted;
+        if (node->key >= key) {
+            root = node->left;
+            node->left = nullptr;
+            right.root = node;
+        } else {
+            right.root = node->right;
+            node->right = nullptr;
+        }
+        if (root) root->parent = nullptr;
+        if (right.root) right.root->parent = nullptr;
+    }
+
+    // Move all keys of `other` to this tree and leave `other` empty.
+    // All keys of `other` must be greater than all keys of this tree.
+    void join(SplayTree& other) {
+        if (!root) {
+            root = other.root;
+        } else if (other.root) {
+            long long counted = rotations;
+            this->splay_max();
+            rotations = counted;
+            root->right = other.root;
+            other.root->parent = root;
+        }
+        other.root = nullptr;
+    }
+
+    // Move all keys k with lo <= k <= hi into the empty tree `out`.
+    void extract_range(int lo, int hi, SplayTree& out) {
+        EXPECT(!out.root, "The tree receiving the extracted keys must be empty");
+        if (lo > hi)
+            return;
+        SplayTree rest;
+        this->split(lo, out);
+        if (hi < INT_MAX)
+            out.split(hi + 1, rest);
+        this->join(rest);
+    }
+
+    // Delete all keys k with lo <= k <= hi.
+    void remove_range(int lo, int hi) {
+        SplayTree removed;
+        this->extract_range(lo, hi, removed);
+    }
+
+    // Move all keys of `other` to this tree and leave `other` empty.
+    // The keys may interleave; the trees are cut into alternating runs of keys
+    // by split and the runs are joined, so the cost depends on the number of
+    // runs instead of the number of keys. Keys present in both trees are kept once.
+    void merge(SplayTree& other) {
+        SplayTree result;
+        SplayTree* first = this;
+        SplayTree* second = &other;
+        SplayTree high;
+        long long counted = rotations, other_counted = other.rotations;
+        while (first->root && second->root) {
+            first->splay_min();
+            second->splay_min();
+            if (first->root->key > second->root->key) {
+                SplayTree* tmp = first;
+                first = second;
+                second = tmp;
+            }
+            // the run of `first` smaller than the minimum of `second` goes to the result
+            int key = second->root->key;
+            first->split(key, high);
+            result.join(*first);
+            first->root = high.root;
+            high.root = nullptr;
+            // a key present in both trees is the minimum of `first` now, so it has no left child
+            Node* node = first->descend(key);
+            if (node && node->key == key) {
+                first->splay(node);
+                first->root = node->right;
+                if (first->root) first->root->parent = nullptr;
+                delete node;
+            }
+        }
+        result.join(*first);
+        result.join(*second);
+        root = result.root;
+        result.root = nullptr;
+        rotations = counted;
+        other.rotations = other_counted;
+    }
+
     // Destructor to free all allocated memory.
     ~SplayTree() {
         Node* node = root;
@@ -0,0 +1,149 @@
+// Splay tree with top-down splaying
+// The splay is done during a single descent, so nodes need no parent pointer.
+class TopDownSplayTree {
+   private:
+    // A node of the tree
+    class Node {
+       public:
+        int key;
+        Node* left;
+        Node* right;
+
+        // Constructor
+        Node(int key, Node* left = nullptr, Node* right = nullptr) {
+            this->key = key;
+            this->left = left;
+            this->right = right;
+        }
+    };
+
+    // Pointer to root of the tree; nullptr if the tree is empty.
+    Node* root;
+
+    // Splay the node with the given key, or the last node on the search path
+    // if the key is not present, to the root. Nodes smaller than the path are
+    // collected in the left assembly tree and the bigger ones in the right one,
+    // both are attached to the new root at the end.
+    void splay(int key) {
+        if (!root)
+            return;
+
+        Node header(0);
+        Node* left_max = &header;   // the biggest node of the left assembly tree
+        Node* right_min = &header;  // the smallest node of the right assembly tree
+        Node* node = root;
+
+        while (true) {
+            if (key < node->key) {
+                if (!node->left)
+                    break;
+                // zig-zig rotation
+                if (key < node->left->key) {
+                    Node* child = node->left;
+                    node->left = child->right;
+                    child->right = node;
+                    node = child;
+                    if (!node->left)
+                        break;
+                }
+                // link right
+                right_min->left = node;
+                right_min = node;
+                node = node->left;
+            } else if (key > node->key) {
+                if (!node->right)
+                    break;
+                // zig-zig rotation
+                if (key > node->right->key) {
+                    Node* child = node->right;
+                    node->right = child->left;
+                    child->left = node;
+                    node = child;
+                    if (!node->right)
+                        break;
+                }
+                // link left
+                left_max->right = node;
+                left_max = node;
+                node = node->right;
+            } else {
+                break;
+            }
+        }
+
+        // assemble
+        left_max->right = node->left;
+        right_min->left = node->right;
+        node->left = header.right;
+        node->right = header.left;
+        root = node;
+    }
+
+   public:
+    // Constructor for Splay tree
+    TopDownSplayTree(Node* root = nullptr) {
+        this->root = root;
+    }
+
+    // Look up the given key in the tree, returning the
+    // the node with the requested key or nullptr.
+    Node* lookup(int key) {
+        this->splay(key);
+        return root && root->key == key ? root : nullptr;
+    }
+
+    // Insert a key into the tree.
+    // If the key is already present, nothing happens.
+    void insert(int key) {
+        if (!root) {
+            root = new Node(key);
+            return;
+        }
+
+        this->splay(key);
+        if (key < root->key) {
+            root = new Node(key, root->left, root);
+            root->right->left = nullptr;
+        } else if (key > root->key) {
+            root = new Node(key, root, root->right);
+            root->left->right = nullptr;
+        }
+    }
+
+    // Delete given key from the tree.
+    // It the key is not present, nothing happens.
+    void remove(int key) {
+        this->splay(key);
+        if (!root || root->key != key)
+            return;
+
+        Node* node = root;
+        if (!node->left) {
+            root = node->right;
+        } else {
+            // the maximum of the left subtree has no right child after splaying
+            root = node->left;
+            this->splay(key);
+            root->right = node->right;
+        }
+        delete node;
+    }
+
+    // Destructor to free all allocated memory.
+    ~TopDownSplayTree() {
+        // rotate left children up until the tree is a right path, deleting it on the way
+        Node* node = root;
+        while (node) {
+            if (node->left) {
+                Node* child = node->left;
+                node->left = child->right;
+                child->right = node;
+                node = child;
+            } else {
+                Node* next = node->right;
+                delete node;
+                node = next;
+            }
+        }
+    }
+};
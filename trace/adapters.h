@@ -0,0 +1,111 @@
+#ifndef DS_TRACE_ADAPTERS_H
+#define DS_TRACE_ADAPTERS_H
+
+#include <cstdint>
+
+#include "../ab_tree.cpp"
+#include "../avl_tree.cpp"
+#include "../bplus_tree.cpp"
+#include "../buffered_ab_tree.cpp"
+#include "../cuckoo_hash_table/cuckoo_hash.h"
+#include "../splay_tree.cpp"
+#include "../top_down_splay_tree.cpp"
+#include "trace.h"
+
+/*
+ * Adapters giving all structures the same interface:
+ * insert(key), find(key) and remove(key) with 32-bit keys.
+ * Structures without removal ignore remove.
+ */
+
+class AVLAdapter {
+    AVLTree tree;
+
+   public:
+    void insert(uint32_t key) { tree.insert(key); }
+    bool find(uint32_t key) { return tree.find(key) > 0; }
+    void remove(uint32_t key) { tree.remove(key); }
+};
+
+class SplayAdapter {
+    SplayTree tree;
+
+   public:
+    void insert(uint32_t key) { tree.insert(key); }
+    bool find(uint32_t key) { return tree.lookup(key) != nullptr; }
+    void remove(uint32_t key) { tree.remove(key); }
+};
+
+class TopDownSplayAdapter {
+    TopDownSplayTree tree;
+
+   public:
+    void insert(uint32_t key) { tree.insert(key); }
+    bool find(uint32_t key) { return tree.lookup(key) != nullptr; }
+    void remove(uint32_t key) { tree.remove(key); }
+};
+
+class ABTreeAdapter {
+    ab_tree tree;
+
+   public:
+    ABTreeAdapter(int a = 2, int b = 8) : tree(a, b) {}
+    void insert(uint32_t key) { tree.insert(key); }
+    bool find(uint32_t key) { return tree.find(key); }
+    void remove(uint32_t key) { tree.remove(key); }
+};
+
+class BPlusTreeAdapter {
+    bplus_tree tree;
+
+   public:
+    BPlusTreeAdapter(int a = 2, int b = 8) : tree(a, b) {}
+    void insert(uint32_t key) { tree.insert(key); }
+    bool find(uint32_t key) { return tree.find(key); }
+    void remove(uint32_t) {}
+};
+
+class BufferedABTreeAdapter {
+    buffered_ab_tree tree;
+
+   public:
+    BufferedABTreeAdapter(int a = 2, int b = 8, int buffer_size = 64) : tree(a, b, buffer_size) {}
+    void insert(uint32_t key) { tree.insert(key); }
+    bool find(uint32_t key) { return tree.find(key); }
+    void remove(uint32_t key) { tree.remove(key); }
+};
+
+class CuckooAdapter {
+    CuckooTable table;
+
+   public:
+    // The table does not grow, so it has to be large enough for all keys.
+    CuckooAdapter(unsigned num_buckets) : table(num_buckets) {}
+    void insert(uint32_t key) { table.insert(key); }
+    bool find(uint32_t key) { return table.lookup(key); }
+    void remove(uint32_t key) { table.remove(key); }
+};
+
+/* Adapter which records every operation with OperationTracer before performing it */
+template <class Adapter>
+class Traced : public Adapter {
+   public:
+    using Adapter::Adapter;
+
+    void insert(uint32_t key) {
+        OperationTracer::record(TRACE_INSERT, key);
+        Adapter::insert(key);
+    }
+
+    bool find(uint32_t key) {
+        OperationTracer::record(TRACE_FIND, key);
+        return Adapter::find(key);
+    }
+
+    void remove(uint32_t key) {
+        OperationTracer::record(TRACE_REMOVE, key);
+        Adapter::remove(key);
+    }
+};
+
+#endif
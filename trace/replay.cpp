@@ -0,0 +1,252 @@
+/*
+ * Replay a recorded trace through one of the structures and report
+ * throughput, latency percentiles and memory footprint. The trace is
+ * streamed block by block and latencies go to a fixed-size histogram,
+ * so the memory of the tool does not grow with the length of the trace.
+ *
+ * Build: g++ -O2 -std=c++11 -pthread trace/replay.cpp -o replay
+ * Usage: replay <avl|splay|top_down_splay|ab|bplus|buffered_ab|cuckoo> <trace file>
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <unordered_set>
+
+#include "adapters.h"
+
+void expect_failed(const string &message) {
+    cerr << "Test error: " << message << endl;
+    exit(1);
+}
+
+/*** Memory accounting: every allocation remembers its size in a header ***/
+
+static size_t current_bytes = 0;
+static size_t peak_bytes = 0;
+static size_t base_bytes = 0;  // Memory in use before the structure was created
+static const size_t ALLOCATION_HEADER = 16;
+
+// The hooks are kept out of line: inlined into the destructor of a container,
+// the header access before the pointer makes GCC warn about array bounds.
+#if defined(__GNUC__)
+#define ALLOCATION_HOOK __attribute__((noinline))
+#else
+#define ALLOCATION_HOOK
+#endif
+
+ALLOCATION_HOOK void *operator new(size_t size) {
+    char *p = (char *)malloc(size + ALLOCATION_HEADER);
+    if (!p)
+        throw bad_alloc();
+    *(size_t *)p = size;
+    current_bytes += size;
+    peak_bytes = max(peak_bytes, current_bytes);
+    return p + ALLOCATION_HEADER;
+}
+
+ALLOCATION_HOOK void operator delete(void *pointer) noexcept {
+    if (!pointer)
+        return;
+    char *p = (char *)pointer - ALLOCATION_HEADER;
+    current_bytes -= *(size_t *)p;
+    free(p);
+}
+
+void *operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete[](void *pointer) noexcept {
+    operator delete(pointer);
+}
+
+void operator delete(void *pointer, size_t) noexcept {
+    operator delete(pointer);
+}
+
+void operator delete[](void *pointer, size_t) noexcept {
+    operator delete(pointer);
+}
+
+/*** Latency histogram: logarithmic buckets, each split into 16 linear ones ***/
+
+class LatencyHistogram {
+    static const int SUB_BUCKETS = 16;
+    static const int BUCKETS = 61 * SUB_BUCKETS;  // enough for all 64-bit values
+
+    uint64_t counts[BUCKETS];
+    uint64_t total;
+    uint64_t max_value;
+
+    // Values below SUB_BUCKETS have their own buckets, larger ones are
+    // rounded down to their 5 highest bits, so the error is at most 1/16.
+    static int bucket(uint64_t value) {
+        if (value < SUB_BUCKETS)
+            return value;
+        int shift = 0;
+        while ((value >> shift) >= 2 * SUB_BUCKETS)
+            shift++;
+        return (shift + 1) * SUB_BUCKETS + (value >> shift) - SUB_BUCKETS;
+    }
+
+    // The largest value falling into the given bucket
+    static uint64_t bucket_max(int b) {
+        if (b < SUB_BUCKETS)
+            return b;
+        int shift = b / SUB_BUCKETS - 1;
+        uint64_t mantissa = SUB_BUCKETS + b % SUB_BUCKETS;
+        return ((mantissa + 1) << shift) - 1;
+    }
+
+   public:
+    LatencyHistogram() {
+        memset(counts, 0, sizeof(counts));
+        total = 0;
+        max_value = 0;
+    }
+
+    void add(uint64_t value) {
+        counts[bucket(value)]++;
+        total++;
+        max_value = max(max_value, value);
+    }
+
+    uint64_t count() const { return total; }
+    uint64_t maximum() const { return max_value; }
+
+    // Upper estimate of the given percentile
+    uint64_t percentile(double p) const {
+        uint64_t rank = (uint64_t)(p / 100 * (total - 1));
+        uint64_t seen = 0;
+        for (int b = 0; b < BUCKETS; b++) {
+            seen += counts[b];
+            if (seen > rank)
+                return min(bucket_max(b), max_value);
+        }
+        return max_value;
+    }
+};
+
+/*** Replay ***/
+
+// Replay the rest of the trace block by block. Returns false if the trace is damaged.
+// The block has to be reserved for TRACE_BLOCK_RECORDS, so that replay does not allocate.
+template <class Adapter>
+bool replay(Adapter &structure, TraceReader &reader, vector<TraceRecord> &block, bool skip_max_key) {
+    typedef chrono::steady_clock clock;
+    LatencyHistogram latencies;
+    long long found = 0;
+
+    clock::time_point start = clock::now();
+    while (reader.next_block(block)) {
+        for (size_t i = 0; i < block.size(); i++) {
+            const TraceRecord &r = block[i];
+            clock::time_point before = clock::now();
+            if (skip_max_key && r.key == 0xffffffff) {
+                // key reserved by the structure
+            } else if (r.op == TRACE_INSERT) {
+                structure.insert(r.key);
+            } else if (r.op == TRACE_FIND) {
+                found += structure.find(r.key);
+            } else {
+                structure.remove(r.key);
+            }
+            latencies.add(chrono::duration_cast<chrono::nanoseconds>(clock::now() - before).count());
+        }
+    }
+    double seconds = chrono::duration<double>(clock::now() - start).count();
+    if (!reader.is_valid())
+        return false;
+
+    cout << "operations:      " << latencies.count() << endl;
+    cout << "successful finds: " << found << endl;
+    cout << "throughput:      " << (seconds > 0 ? latencies.count() / seconds : 0) << " ops/s" << endl;
+    if (latencies.count() > 0) {
+        const double percentiles[] = {50, 90, 99, 99.9};
+        for (double p : percentiles)
+            cout << "latency p" << p << ": " << latencies.percentile(p) << " ns" << endl;
+        cout << "latency max:     " << latencies.maximum() << " ns" << endl;
+    }
+    cout << "memory:          " << current_bytes - base_bytes << " bytes at the end, "
+         << peak_bytes - base_bytes << " bytes at peak" << endl;
+    return true;
+}
+
+int main(int argc, char **argv) {
+    if (argc != 3) {
+        cerr << "Usage: " << argv[0] << " <avl|splay|top_down_splay|ab|bplus|buffered_ab|cuckoo> <trace file>" << endl;
+        return 1;
+    }
+    string structure = argv[1];
+    string path = argv[2];
+
+    // The cuckoo table does not grow and two hash functions start failing
+    // at the load factor 1/2, so it gets at least 4 buckets per key which
+    // is present at the same time, rounded up to a power of two.
+    size_t buckets = 16;
+    if (structure == "cuckoo") {
+        size_t peak_keys = 0;
+        {
+            TraceReader counter(path);
+            vector<TraceRecord> block;
+            unordered_set<uint32_t> keys;
+            while (counter.next_block(block))
+                for (size_t i = 0; i < block.size(); i++) {
+                    if (block[i].op == TRACE_INSERT && block[i].key != 0xffffffff)
+                        keys.insert(block[i].key);
+                    else if (block[i].op == TRACE_REMOVE)
+                        keys.erase(block[i].key);
+                    peak_keys = max(peak_keys, keys.size());
+                }
+        }
+        while (buckets < 4 * peak_keys)
+            buckets *= 2;
+        EXPECT(buckets <= 0x80000000u, "The trace holds too many keys for the cuckoo table");
+    }
+
+    TraceReader reader(path);
+    if (!reader.is_valid()) {
+        cerr << "Cannot read trace " << path << endl;
+        return 1;
+    }
+    vector<TraceRecord> block;
+    block.reserve(TRACE_BLOCK_RECORDS);
+
+    // the reader and the block are not part of the structure
+    base_bytes = current_bytes;
+    peak_bytes = current_bytes;
+    bool valid;
+    if (structure == "avl") {
+        AVLAdapter s;
+        valid = replay(s, reader, block, false);
+    } else if (structure == "splay") {
+        SplayAdapter s;
+        valid = replay(s, reader, block, false);
+    } else if (structure == "top_down_splay") {
+        TopDownSplayAdapter s;
+        valid = replay(s, reader, block, false);
+    } else if (structure == "ab") {
+        ABTreeAdapter s;
+        valid = replay(s, reader, block, false);
+    } else if (structure == "bplus") {
+        BPlusTreeAdapter s;
+        valid = replay(s, reader, block, false);
+    } else if (structure == "buffered_ab") {
+        BufferedABTreeAdapter s;
+        valid = replay(s, reader, block, false);
+    } else if (structure == "cuckoo") {
+        CuckooAdapter s(buckets);
+        valid = replay(s, reader, block, true);
+    } else {
+        cerr << "Unknown structure " << structure << endl;
+        return 1;
+    }
+    if (!valid) {
+        cerr << "Trace " << path << " is damaged" << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,302 @@
+#ifndef DS_TRACE_H
+#define DS_TRACE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * Recording of operations on the data structures.
+ *
+ * A trace file starts with the 8 bytes "DSTRACE2", followed by blocks.
+ * Each block is a 32-bit number of records (at most TRACE_BLOCK_RECORDS)
+ * followed by the records, packed into 5 bytes each: the 32-bit key and
+ * the operation. Numbers are stored in the byte order of the machine.
+ * Every thread collects its records in its own buffer and hands full
+ * buffers over to a background thread which writes them, so recording
+ * one operation is a store into thread-local memory under an uncontended
+ * per-thread lock. Records of one thread keep their order, records of
+ * different threads are interleaved at block granularity.
+ *
+ * Tracing is off until OperationTracer::instance().start(path) is called.
+ * start() and stop() may be called while other threads keep recording;
+ * operations recorded concurrently with stop() may be left out of the trace.
+ */
+
+enum TraceOp : uint8_t {
+    TRACE_INSERT = 0,
+    TRACE_FIND = 1,
+    TRACE_REMOVE = 2,
+};
+
+struct TraceRecord {
+    uint32_t key;
+    uint8_t op;
+};
+
+static const char TRACE_MAGIC[8] = {'D', 'S', 'T', 'R', 'A', 'C', 'E', '2'};
+static const size_t TRACE_BLOCK_RECORDS = 4096;
+static const size_t TRACE_RECORD_BYTES = 5;
+
+class OperationTracer {
+    /*
+     * Records of one thread which were not handed over yet. The lock is only
+     * contended when stop() collects the records, so it is cheap for the owner.
+     */
+    struct ThreadBuffer {
+        std::mutex lock;
+        std::vector<TraceRecord> records;
+
+        ThreadBuffer() {
+            records.reserve(TRACE_BLOCK_RECORDS);
+            OperationTracer::instance().register_buffer(this);
+        }
+
+        /* Hand over the rest when the thread exits */
+        ~ThreadBuffer() {
+            OperationTracer::instance().unregister_buffer(this);
+        }
+    };
+
+    std::atomic<bool> enabled;
+    FILE *file;
+    std::thread writer;
+    bool stopping;
+
+    /* Everything below is protected by the mutex */
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::vector<std::vector<TraceRecord>> full_blocks;
+    std::vector<std::vector<TraceRecord>> spare_blocks;
+    std::vector<ThreadBuffer *> buffers;
+
+    OperationTracer() {
+        enabled.store(false);
+        file = nullptr;
+        stopping = false;
+    }
+
+    static ThreadBuffer &thread_buffer() {
+        static thread_local ThreadBuffer buffer;
+        return buffer;
+    }
+
+    void register_buffer(ThreadBuffer *buffer) {
+        std::lock_guard<std::mutex> lock(mutex);
+        buffers.push_back(buffer);
+    }
+
+    /* Lock order: the tracer mutex before a buffer lock, never the other way round */
+    void unregister_buffer(ThreadBuffer *buffer) {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::lock_guard<std::mutex> buffer_lock(buffer->lock);
+        if (!buffer->records.empty())
+            submit_locked(buffer->records);
+        for (size_t i = 0; i < buffers.size(); i++)
+            if (buffers[i] == buffer) {
+                buffers[i] = buffers.back();
+                buffers.pop_back();
+                break;
+            }
+    }
+
+    /*
+     * Queue the records for writing and leave an empty block in their place.
+     * Records arriving after stop() are dropped.
+     */
+    void submit_locked(std::vector<TraceRecord> &records) {
+        if (!file || stopping) {
+            records.clear();
+            return;
+        }
+        full_blocks.push_back(std::vector<TraceRecord>());
+        full_blocks.back().swap(records);
+        if (!spare_blocks.empty()) {
+            records.swap(spare_blocks.back());
+            spare_blocks.pop_back();
+        } else {
+            records.reserve(TRACE_BLOCK_RECORDS);
+        }
+        ready.notify_one();
+    }
+
+    void submit(std::vector<TraceRecord> &records) {
+        std::lock_guard<std::mutex> lock(mutex);
+        submit_locked(records);
+    }
+
+    /* Body of the background thread: pack and write full blocks until stopped */
+    void write_blocks() {
+        std::vector<unsigned char> packed(TRACE_BLOCK_RECORDS * TRACE_RECORD_BYTES);
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            ready.wait(lock, [this] { return stopping || !full_blocks.empty(); });
+            if (full_blocks.empty() && stopping)
+                return;
+            std::vector<std::vector<TraceRecord>> blocks;
+            blocks.swap(full_blocks);
+            lock.unlock();
+            for (size_t i = 0; i < blocks.size(); i++) {
+                uint32_t count = blocks[i].size();
+                for (uint32_t j = 0; j < count; j++) {
+                    memcpy(&packed[j * TRACE_RECORD_BYTES], &blocks[i][j].key, 4);
+                    packed[j * TRACE_RECORD_BYTES + 4] = blocks[i][j].op;
+                }
+                fwrite(&count, sizeof(count), 1, file);
+                fwrite(packed.data(), TRACE_RECORD_BYTES, count, file);
+                blocks[i].clear();
+            }
+            lock.lock();
+            for (size_t i = 0; i < blocks.size(); i++)
+                spare_blocks.push_back(std::move(blocks[i]));
+        }
+    }
+
+   public:
+    static OperationTracer &instance() {
+        static OperationTracer tracer;
+        return tracer;
+    }
+
+    /* Start writing a new trace to the given file. Returns false if it cannot be created. */
+    bool start(const std::string &path) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (file)
+            return false;
+        file = fopen(path.c_str(), "wb");
+        if (!file)
+            return false;
+        fwrite(TRACE_MAGIC, sizeof(TRACE_MAGIC), 1, file);
+        stopping = false;
+        writer = std::thread(&OperationTracer::write_blocks, this);
+        enabled.store(true);
+        return true;
+    }
+
+    /* Stop tracing, write the rest of all buffers and close the file. */
+    void stop() {
+        enabled.store(false);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!file)
+                return;
+            for (size_t i = 0; i < buffers.size(); i++) {
+                std::lock_guard<std::mutex> buffer_lock(buffers[i]->lock);
+                if (!buffers[i]->records.empty())
+                    submit_locked(buffers[i]->records);
+            }
+            stopping = true;
+            ready.notify_one();
+        }
+        writer.join();
+        std::lock_guard<std::mutex> lock(mutex);
+        fclose(file);
+        file = nullptr;
+    }
+
+    bool is_enabled() const {
+        return enabled.load(std::memory_order_relaxed);
+    }
+
+    /* Record one operation of the calling thread */
+    static void record(TraceOp op, uint32_t key) {
+        OperationTracer &tracer = instance();
+        if (!tracer.is_enabled())
+            return;
+        ThreadBuffer &buffer = thread_buffer();
+        TraceRecord record;
+        record.key = key;
+        record.op = op;
+
+        // a full block is taken out under the buffer lock and handed over
+        // without it, so that stop() holding the tracer mutex cannot deadlock with us
+        std::vector<TraceRecord> full;
+        {
+            std::lock_guard<std::mutex> buffer_lock(buffer.lock);
+            if (!tracer.is_enabled())
+                return;  // stop() may have collected the buffer already
+            buffer.records.push_back(record);
+            if (buffer.records.size() < TRACE_BLOCK_RECORDS)
+                return;
+            full.swap(buffer.records);
+        }
+        tracer.submit(full);  // leaves a cleared spare block in `full`
+        if (full.capacity() < TRACE_BLOCK_RECORDS)
+            full.reserve(TRACE_BLOCK_RECORDS);
+        std::lock_guard<std::mutex> buffer_lock(buffer.lock);
+        if (buffer.records.empty())
+            buffer.records.swap(full);
+    }
+
+    ~OperationTracer() {
+        stop();
+    }
+};
+
+/*
+ * Sequential reader of a trace, one block at a time, so that traces
+ * larger than the memory can be replayed.
+ */
+class TraceReader {
+    FILE *file;
+    bool valid;
+    std::vector<unsigned char> packed;
+
+   public:
+    /* Open the trace; valid() tells whether it exists and starts with the right header. */
+    explicit TraceReader(const std::string &path) {
+        file = fopen(path.c_str(), "rb");
+        char magic[sizeof(TRACE_MAGIC)];
+        valid = file && fread(magic, sizeof(magic), 1, file) == 1 && memcmp(magic, TRACE_MAGIC, sizeof(magic)) == 0;
+        packed.resize(TRACE_BLOCK_RECORDS * TRACE_RECORD_BYTES);
+    }
+
+    ~TraceReader() {
+        if (file)
+            fclose(file);
+    }
+
+    TraceReader(const TraceReader &) = delete;
+    TraceReader &operator=(const TraceReader &) = delete;
+
+    bool is_valid() const {
+        return valid;
+    }
+
+    /*
+     * Replace the records by the next block. Returns false at the end of the trace
+     * or if the trace is damaged, which is_valid() tells apart afterwards.
+     */
+    bool next_block(std::vector<TraceRecord> &records) {
+        records.clear();
+        uint32_t count;
+        if (!valid || fread(&count, sizeof(count), 1, file) != 1)
+            return false;
+        valid = count <= TRACE_BLOCK_RECORDS && fread(packed.data(), TRACE_RECORD_BYTES, count, file) == count;
+        if (!valid)
+            return false;
+        records.resize(count);
+        for (uint32_t i = 0; i < count; i++) {
+            memcpy(&records[i].key, &packed[i * TRACE_RECORD_BYTES], 4);
+            records[i].op = packed[i * TRACE_RECORD_BYTES + 4];
+        }
+        return true;
+    }
+};
+
+/* Read a whole trace into memory. Returns false if the file is not a valid trace. */
+inline bool read_trace(const std::string &path, std::vector<TraceRecord> &records) {
+    TraceReader reader(path);
+    std::vector<TraceRecord> block;
+    while (reader.next_block(block))
+        records.insert(records.end(), block.begin(), block.end());
+    return reader.is_valid();
+}
+
+#endif